@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <chrono>
 #include <random>
+#include <unordered_map>
 using namespace std;
 
 /* Test parameters (e.g., array sizes or value range) */
@@ -57,7 +58,8 @@ public:
 BitBranchingTreeNode* nodes;
 int nodesSize = 0;
 
-static void inOrderTraversal(vector<int>& sortedArray, int nodeIndex = 0)
+template <typename Visit>
+static void inOrderTraversal(const Visit& visit, int nodeIndex = 0)
 {
 	BitBranchingTreeNode* node = &nodes[nodeIndex];
 	unsigned int branchesTo1sBitMask = node->reservedBranchesBitMask & ~(node->value);
@@ -66,19 +68,16 @@ static void inOrderTraversal(vector<int>& sortedArray, int nodeIndex = 0)
 	while (branchesTo0sBitMask != 0)
 	{
 		unsigned int branchIndex = KEY_SIZE - 1 - countLeadingZeros(branchesTo0sBitMask);
-		inOrderTraversal(sortedArray, node->branchIndices[branchIndex]);
+		inOrderTraversal(visit, node->branchIndices[branchIndex]);
 		branchesTo0sBitMask ^= 1 << branchIndex;
 	}
 
-	for (int i = 0; i < node->count; i++)
-	{
-		sortedArray.push_back(node->value);
-	}
+	visit(node->value, node->count);
 
 	while (branchesTo1sBitMask != 0)
 	{
 		unsigned int branchIndex = countTrailingZeros(branchesTo1sBitMask);
-		inOrderTraversal(sortedArray, node->branchIndices[branchIndex]);
+		inOrderTraversal(visit, node->branchIndices[branchIndex]);
 		branchesTo1sBitMask ^= 1 << branchIndex;
 	}
 }
@@ -124,7 +123,8 @@ static void insertValue(int value)
 	}
 }
 
-static vector<int> bitTreeSort(const vector<int>& array)
+template <typename Visit>
+static void bitTreeTraversal(const vector<int>& array, const Visit& visit)
 {
 	nodes = new BitBranchingTreeNode[array.size()];
 	nodesSize = 0;
@@ -134,14 +134,31 @@ static vector<int> bitTreeSort(const vector<int>& array)
 		insertValue(value);
 	}
 
-	vector<int> sortedArray;
-	sortedArray.reserve(array.size());
-	inOrderTraversal(sortedArray);
+	inOrderTraversal(visit);
 
 	delete[] nodes;
+}
+
+static vector<int> bitTreeSort(const vector<int>& array)
+{
+	vector<int> sortedArray;
+	sortedArray.reserve(array.size());
+	bitTreeTraversal(array, [&sortedArray](int value, int count) {
+		for (int i = 0; i < count; i++)
+		{
+			sortedArray.push_back(value);
+		}
+	});
 	return sortedArray;
 }
 
+static vector<pair<int, int>> bitTreeSortRunLength(const vector<int>& array)
+{
+	vector<pair<int, int>> runs;
+	bitTreeTraversal(array, [&runs](int value, int count) { runs.emplace_back(value, count); });
+	return runs;
+}
+
 static bool isSorted(const vector<int>& array)
 {
 	for (size_t i = 1; i < array.size(); ++i)
@@ -192,6 +209,8 @@ int main()
 		double heapSortTotalTime = 0.0;
 		double quickSortTotalTime = 0.0;
 		double stableSortTotalTime = 0.0;
+		double bitBranchingRunLengthSortTotalTime = 0.0;
+		double hashMapCountingSortTotalTime = 0.0;
 
 		int size = 1;
 		for (int j = 0; j < i; ++j)
@@ -256,6 +275,28 @@ int main()
 			end = chrono::high_resolution_clock::now();
 			elapsed = end - start;
 			stableSortTotalTime += elapsed.count();
+
+			// Measure bit branching run-length sort execution time (average over 10 runs)
+			start = chrono::high_resolution_clock::now();
+			vector<pair<int, int>> runs = bitTreeSortRunLength(array);
+			end = chrono::high_resolution_clock::now();
+			elapsed = end - start;
+			bitBranchingRunLengthSortTotalTime += elapsed.count();
+
+			// Measure hash map counting followed by sorting the counted values execution time (average over 10 runs)
+			start = chrono::high_resolution_clock::now();
+			unordered_map<int, int> counts;
+			for (int value : array)
+			{
+				counts[value]++;
+			}
+			vector<pair<int, int>> countedRuns(counts.begin(), counts.end());
+			sort(countedRuns.begin(), countedRuns.end());
+			end = chrono::high_resolution_clock::now();
+			elapsed = end - start;
+			hashMapCountingSortTotalTime += elapsed.count();
+
+			assert(runs == countedRuns);
 		}
 
 		cout << "Array size: " << size << endl;
@@ -264,6 +305,8 @@ int main()
 		cout << "Heap Sort Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << (heapSortTotalTime * 1000 / 10.0) << " ms" << endl;
 		cout << "Quick Sort Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << (quickSortTotalTime * 1000 / 10.0) << " ms" << endl;
 		cout << "Stable Sort Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << (stableSortTotalTime * 1000 / 10.0) << " ms" << endl;
+		cout << "Bit Branching Run-Length Sort Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << (bitBranchingRunLengthSortTotalTime * 1000 / 10.0) << " ms" << endl;
+		cout << "Hash Map Counting Sort Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << (hashMapCountingSortTotalTime * 1000 / 10.0) << " ms" << endl;
 		cout << endl;
 	}
 
@@ -1,7 +1,7 @@
 /*
 * For convenience, this file contains both the definition for Bit Branching Trees and the code for
 * benchmarking their performance. The below configurations can be used to change test parameters.
-* This file was tested on MSC and GCC compilers.
+* This file was tested on MSC and GCC compilers, and requires C++17 (e.g., for std::pmr memory resources).
 *
 * To benchmark against other structures, add the below to main() under other similar blocks:
 * auto structureTotalTime = measure( // Update the name of structureTotalTime as you see fit
@@ -24,7 +24,10 @@
 #include <set>
 #include <map>
 #include <unordered_set>
+#include <unordered_map>
 #include <functional>
+#include <memory>
+#include <memory_resource>
 using namespace std;
 
 /* Test parameters (e.g., array sizes or value range) */
@@ -38,6 +41,17 @@ using namespace std;
 #define INCLUDE_DELETION true // Whether or not to include erasing time in the final calculation
 #define INCLUDE_TRAVERSAL false // Whether or not to include ordered traversal time in the final calculation
 
+/* Frequency analytics parameters */
+#define FREQUENCY_MAX_VALUE 0 // The max range of used numbers for the frequency benchmark, setting this to 0 uses size/100 as the range so that values repeat
+#define TOP_K 10 // The number of most frequent values requested in the frequency benchmark
+#define HISTOGRAM_BUCKET_BITS 8 // The number of high bits used to bucket values in the frequency benchmark's histogram
+
+/* Rebalancing parameters */
+#define PARTITION_COUNT 8 // The number of ranges the tree is cut into in the rebalancing benchmark (e.g., the number of worker threads)
+
+/* Allocation parameters */
+#define REQUEST_SIZE 1000 // The number of values inserted into each short-lived tree in the allocation benchmark
+
 #define KEY_SIZE 32 // The key size for integers, used in the below tests. This implementation does not allow changing this constant
 
 /* Below definitions call comiler-specifc function for the purpose of counting leading/trailing zeroes in numbers */
@@ -80,16 +94,94 @@ public:
 	int reservedPointersBitMask = 0;
 	/* The number of occurances of this value, this can be replaced with a singly-linked list for object comparison */
 	int count = 1;
+	/* The total number of occurances in this node's subtree (including its own), used to answer size and histogram queries without visiting the subtree */
+	int subtreeCount = 1;
+	/* The number of distinct values (i.e., nodes) in this node's subtree, including itself */
+	int subtreeNodeCount = 1;
 	/* The node's value */
 	int value;
 };
 
 
-/* The bit branching tree class */
-class bit_branching_tree
+/* The bit branching tree class, which allocates its nodes using the given allocator */
+template <typename Allocator = allocator<bit_branching_tree_node>>
+class basic_bit_branching_tree
 {
 private:
+	using node_allocator = typename allocator_traits<Allocator>::template rebind_alloc<bit_branching_tree_node>;
+	using node_allocator_traits = allocator_traits<node_allocator>;
+
 	bit_branching_tree_node* root = nullptr;
+	node_allocator nodeAllocator;
+	/* The most memory in bytes the tree's nodes can take, where 0 means unlimited */
+	size_t memoryBudget = 0;
+
+	/* Allocates and constructs a new node using the tree's allocator */
+	bit_branching_tree_node* createNode(int value)
+	{
+		bit_branching_tree_node* node = node_allocator_traits::allocate(nodeAllocator, 1);
+		node_allocator_traits::construct(nodeAllocator, node, value);
+		return node;
+	}
+
+	/* Destroys and deallocates a node using the tree's allocator */
+	void destroyNode(bit_branching_tree_node* node)
+	{
+		node_allocator_traits::destroy(nodeAllocator, node);
+		node_allocator_traits::deallocate(nodeAllocator, node, 1);
+	}
+
+	/* Destroys every node in the given subtree, recursively */
+	void destroySubtree(bit_branching_tree_node* node)
+	{
+		while (node->reservedPointersBitMask != 0)
+		{
+			int branchIndex = countTrailingZeros(node->reservedPointersBitMask);
+			destroySubtree(node->branches[branchIndex]);
+			node->reservedPointersBitMask ^= 1 << branchIndex;
+		}
+		destroyNode(node);
+	}
+
+	/* Copies every node in the given subtree using the tree's allocator, recursively, and returns the copy's root.
+	If an allocation fails, the nodes copied so far are destroyed before the exception is passed on */
+	bit_branching_tree_node* copySubtree(bit_branching_tree_node* node)
+	{
+		bit_branching_tree_node* copy = createNode(node->value);
+		copy->count = node->count;
+		copy->subtreeCount = node->subtreeCount;
+		copy->subtreeNodeCount = node->subtreeNodeCount;
+
+		unsigned int unvisitedBranchesBitMask = node->reservedPointersBitMask;
+		try
+		{
+			while (unvisitedBranchesBitMask != 0)
+			{
+				int branchIndex = countTrailingZeros(unvisitedBranchesBitMask);
+				copy->branches[branchIndex] = copySubtree(node->branches[branchIndex]);
+				copy->reservedPointersBitMask |= 1 << branchIndex; // Only fully copied branches are reserved, so they are the only ones destroyed on failure
+				unvisitedBranchesBitMask ^= 1 << branchIndex;
+			}
+		}
+		catch (...)
+		{
+			destroySubtree(copy);
+			throw;
+		}
+		return copy;
+	}
+
+	/* Checks whether or not the given memory in bytes fits within the memory budget */
+	bool fitsInBudget(size_t bytes)
+	{
+		return memoryBudget == 0 || bytes <= memoryBudget;
+	}
+
+	/* Checks whether or not another node fits within the memory budget */
+	bool canCreateNode()
+	{
+		return fitsInBudget(memoryUsage() + sizeof(bit_branching_tree_node));
+	}
 
 	/* Traverses the tree in order, recursively, and appends its values to the given array in order */
 	void inOrderTraversal(vector<int>& array, bit_branching_tree_node* node)
@@ -125,21 +217,380 @@ private:
 		}
 	}
 
+	/* Applies the given changes to the subtree counters of every node on a path traced from the root */
+	static void updatePath(bit_branching_tree_node** path, int pathLength, int countChange, int nodeCountChange)
+	{
+		for (int i = 0; i < pathLength; i++)
+		{
+			path[i]->subtreeCount += countChange;
+			path[i]->subtreeNodeCount += nodeCountChange;
+		}
+	}
+
+	/* Returns the node holding the requested value, or null if it isn't in the tree */
+	bit_branching_tree_node* findNode(int value)
+	{
+		bit_branching_tree_node* current = root;
+
+		// Traces a path through the tree until the value is found, or until it is guranteed not to be in the tree
+		while (current)
+		{
+			// Finds the longest common prefix between the node's value and the input by XORing them and counting the result's leading zeros
+			int bitDifference = current->value ^ value;
+			int longestCommonPrefixLength = countLeadingZeros(bitDifference);
+
+			// If the prefix length equals the key size, then the input value and node's value match, so the node is returned
+			if (longestCommonPrefixLength == KEY_SIZE) return current;
+
+			unsigned int branchingIndex = KEY_SIZE - 1 - longestCommonPrefixLength;
+			unsigned int branchingBit = 1 << branchingIndex;
+
+			// Terminates if the next branch to follow has now node under it, as it is confirmed that the value to find isn't in the tree
+			bool branchAlreadyExists = (branchingBit & current->reservedPointersBitMask) > 0;
+			if (!branchAlreadyExists) return nullptr;
+
+			// Otherwise, continues to the next iteration using the next node in the path
+			current = current->branches[branchingIndex];
+		}
+		return nullptr;
+	}
+
+	/* Visits every node in the tree, keeping the k most frequent values in a heap whose front is the least frequent of them */
+	static void collectMostFrequent(vector<pair<int, int>>& heap, int k, bit_branching_tree_node* node)
+	{
+		pair<int, int> entry(node->value, node->count);
+		if ((int)heap.size() < k)
+		{
+			heap.push_back(entry);
+			push_heap(heap.begin(), heap.end(), isMoreFrequent);
+		}
+		else if (isMoreFrequent(entry, heap.front()))
+		{ // Replaces the least frequent value kept so far
+			pop_heap(heap.begin(), heap.end(), isMoreFrequent);
+			heap.back() = entry;
+			push_heap(heap.begin(), heap.end(), isMoreFrequent);
+		}
+
+		unsigned int unvisitedBranchesBitMask = node->reservedPointersBitMask;
+		while (unvisitedBranchesBitMask != 0)
+		{
+			int branchIndex = countTrailingZeros(unvisitedBranchesBitMask);
+			collectMostFrequent(heap, k, node->branches[branchIndex]);
+			unvisitedBranchesBitMask ^= 1 << branchIndex;
+		}
+	}
+
+	/* Orders (value, count) pairs by descending count, breaking ties by ascending value */
+	static bool isMoreFrequent(const pair<int, int>& a, const pair<int, int>& b)
+	{
+		return a.second > b.second || (a.second == b.second && a.first < b.first);
+	}
+
+	/* Adds the counts of the given subtree to the histogram, descending only into branches that can hold values from other buckets */
+	static void histogramTraversal(vector<int>& histogram, int bucketBits, bit_branching_tree_node* node)
+	{
+		int bucketShift = KEY_SIZE - bucketBits;
+		int& bucket = histogram[(unsigned int)node->value >> bucketShift];
+		bucket += node->count;
+
+		unsigned int unvisitedBranchesBitMask = node->reservedPointersBitMask;
+		while (unvisitedBranchesBitMask != 0)
+		{
+			int branchIndex = countTrailingZeros(unvisitedBranchesBitMask);
+			bit_branching_tree_node* branch = node->branches[branchIndex];
+
+			// A branch below the bucket bits shares all of them with this node, so its whole subtree falls in this node's bucket
+			if (branchIndex < bucketShift)
+			{
+				bucket += branch->subtreeCount;
+			}
+			else
+			{
+				histogramTraversal(histogram, bucketBits, branch);
+			}
+			unvisitedBranchesBitMask ^= 1 << branchIndex;
+		}
+	}
+
+	/* Traverses the tree in order, recursively, and visits each value once along with its count */
+	static void inOrderTraversal(const function<void(int, int)>& visit, bit_branching_tree_node* node)
+	{
+		unsigned int unvisitedBranchesTo1sBitMask = node->reservedPointersBitMask & ~node->value;
+		unsigned int unvisitedBranchesTo0sBitMask = node->reservedPointersBitMask & node->value;
+
+		while (unvisitedBranchesTo0sBitMask != 0)
+		{
+			int branchIndex = KEY_SIZE - 1 - countLeadingZeros(unvisitedBranchesTo0sBitMask);
+			inOrderTraversal(visit, node->branches[branchIndex]);
+			unvisitedBranchesTo0sBitMask ^= 1 << branchIndex;
+		}
+
+		visit(node->value, node->count);
+
+		while (unvisitedBranchesTo1sBitMask != 0)
+		{
+			int branchIndex = countTrailingZeros(unvisitedBranchesTo1sBitMask);
+			inOrderTraversal(visit, node->branches[branchIndex]);
+			unvisitedBranchesTo1sBitMask ^= 1 << branchIndex;
+		}
+	}
+
+	/* Recalculates the subtree counters of a node from its own count and its branches' counters, used after branches are moved */
+	static void updateSubtreeCounts(bit_branching_tree_node* node)
+	{
+		node->subtreeCount = node->count;
+		node->subtreeNodeCount = 1;
+
+		unsigned int unvisitedBranchesBitMask = node->reservedPointersBitMask;
+		while (unvisitedBranchesBitMask != 0)
+		{
+			int branchIndex = countTrailingZeros(unvisitedBranchesBitMask);
+			node->subtreeCount += node->branches[branchIndex]->subtreeCount;
+			node->subtreeNodeCount += node->branches[branchIndex]->subtreeNodeCount;
+			unvisitedBranchesBitMask ^= 1 << branchIndex;
+		}
+	}
+
+	/* Places a subtree at the given branch of a node, merging it with the subtree already there if any. The node's counters are left to the caller */
+	void attachBranch(bit_branching_tree_node* node, int branchIndex, bit_branching_tree_node* branch)
+	{
+		unsigned int branchBitMask = 1 << branchIndex;
+		if (node->reservedPointersBitMask & branchBitMask)
+		{
+			node->branches[branchIndex] = mergeSubtrees(node->branches[branchIndex], branch);
+		}
+		else
+		{
+			node->branches[branchIndex] = branch;
+			node->reservedPointersBitMask |= branchBitMask;
+		}
+	}
+
+	/* Merges two subtrees into one and returns its root. Branches found in only one of the subtrees are moved whole, so merging subtrees of disjoint ranges only visits the nodes along their boundary */
+	bit_branching_tree_node* mergeSubtrees(bit_branching_tree_node* node, bit_branching_tree_node* other)
+	{
+		if (!node) return other;
+		if (!other) return node;
+
+		// Finds the longest common prefix between the two roots by XORing them and counting the result's leading zeros
+		unsigned int bitDifference = node->value ^ other->value;
+		int longestCommonPrefixLength = countLeadingZeros(bitDifference);
+
+		if (longestCommonPrefixLength == KEY_SIZE)
+		{ // If both roots hold the same value, their counts are added and their branches, which cover the same ranges, are merged
+			node->count += other->count;
+			while (other->reservedPointersBitMask != 0)
+			{
+				int branchIndex = countTrailingZeros(other->reservedPointersBitMask);
+				attachBranch(node, branchIndex, other->branches[branchIndex]);
+				other->reservedPointersBitMask ^= 1 << branchIndex;
+			}
+			destroyNode(other);
+			updateSubtreeCounts(node);
+			return node;
+		}
+
+		int branchingIndex = KEY_SIZE - 1 - longestCommonPrefixLength;
+		unsigned int branchingBit = 1 << branchingIndex;
+
+		// The other root's branches above the branching bit cover the same ranges as this root's branches at the same indices
+		unsigned int higherBranchesBitMask = other->reservedPointersBitMask & ~((branchingBit << 1) - 1);
+		while (higherBranchesBitMask != 0)
+		{
+			int branchIndex = countTrailingZeros(higherBranchesBitMask);
+			attachBranch(node, branchIndex, other->branches[branchIndex]);
+			higherBranchesBitMask ^= 1 << branchIndex;
+			other->reservedPointersBitMask ^= 1 << branchIndex;
+		}
+
+		// The other root's branch at the branching bit shares this root's bits down to the branching bit, so it belongs under this root's lower branches
+		bit_branching_tree_node* sharedBranch = nullptr;
+		if (other->reservedPointersBitMask & branchingBit)
+		{
+			sharedBranch = other->branches[branchingIndex];
+			other->reservedPointersBitMask ^= branchingBit;
+		}
+
+		// What remains of the other subtree differs from this root at the branching bit, so it belongs under this root's branch there
+		updateSubtreeCounts(other);
+		attachBranch(node, branchingIndex, other);
+
+		if (sharedBranch)
+		{
+			return mergeSubtrees(node, sharedBranch);
+		}
+		updateSubtreeCounts(node);
+		return node;
+	}
+
+	/* Splits a subtree into a subtree of the values smaller than the key and a subtree of the rest, only descending into the branch that holds values on both sides */
+	void splitSubtree(bit_branching_tree_node* node, int key, bit_branching_tree_node*& smaller, bit_branching_tree_node*& rest)
+	{
+		smaller = nullptr;
+		rest = nullptr;
+		if (!node) return;
+
+		// Finds the longest common prefix between the node's value and the key by XORing them and counting the result's leading zeros
+		unsigned int bitDifference = node->value ^ key;
+		int longestCommonPrefixLength = countLeadingZeros(bitDifference);
+
+		// A value matching the key goes with the rest, and all of its branches are above the (non-existent) branching bit
+		unsigned int higherBranchesBitMask = node->reservedPointersBitMask;
+		bool nodeIsSmaller = false;
+		bit_branching_tree_node* branchSmaller = nullptr;
+		bit_branching_tree_node* branchRest = nullptr;
+
+		if (longestCommonPrefixLength != KEY_SIZE)
+		{
+			int branchingIndex = KEY_SIZE - 1 - longestCommonPrefixLength;
+			unsigned int branchingBit = 1 << branchingIndex;
+			higherBranchesBitMask &= ~((branchingBit << 1) - 1);
+			nodeIsSmaller = (node->value & branchingBit) == 0;
+
+			// The branch at the branching bit shares the key's bits down to the branching bit, so it is the only one that needs to be split
+			if (node->reservedPointersBitMask & branchingBit)
+			{
+				splitSubtree(node->branches[branchingIndex], key, branchSmaller, branchRest);
+				node->reservedPointersBitMask ^= branchingBit;
+			}
+
+			// Branches below the branching bit share the node's bit there, so they stay with the node
+		}
+
+		// Branches above the branching bit share the key's bits above them and differ at them, so each is entirely smaller than the key
+		// if the node (i.e., the key) has a 1 at its index. Those on the other side of the node are moved out whole
+		unsigned int movingBranchesBitMask = higherBranchesBitMask & (nodeIsSmaller ? ~node->value : node->value);
+		bit_branching_tree_node* moved = nullptr;
+		while (movingBranchesBitMask != 0)
+		{
+			int branchIndex = countTrailingZeros(movingBranchesBitMask);
+			moved = mergeSubtrees(moved, node->branches[branchIndex]);
+			movingBranchesBitMask ^= 1 << branchIndex;
+			node->reservedPointersBitMask ^= 1 << branchIndex;
+		}
+		updateSubtreeCounts(node);
+
+		if (nodeIsSmaller)
+		{
+			smaller = mergeSubtrees(node, branchSmaller);
+			rest = mergeSubtrees(moved, branchRest);
+		}
+		else
+		{
+			smaller = mergeSubtrees(moved, branchSmaller);
+			rest = mergeSubtrees(node, branchRest);
+		}
+	}
+
 public:
-	/* Inserts a new value into the tree */
-	void insert(int value)
+	basic_bit_branching_tree() = default;
+
+	/* Creates an empty tree that allocates its nodes using the given allocator, optionally limiting their memory to the given budget in bytes */
+	explicit basic_bit_branching_tree(const Allocator& allocator, size_t budget = 0) : nodeAllocator(allocator), memoryBudget(budget) {}
+
+	/* Trees own their nodes, so they can be moved but not copied */
+	basic_bit_branching_tree(const basic_bit_branching_tree&) = delete;
+	basic_bit_branching_tree& operator=(const basic_bit_branching_tree&) = delete;
+
+	basic_bit_branching_tree(basic_bit_branching_tree&& other) noexcept
+		: root(other.root), nodeAllocator(move(other.nodeAllocator)), memoryBudget(other.memoryBudget)
+	{
+		other.root = nullptr;
+	}
+
+	/* Moves another tree's values into this one, keeping this tree's memory budget, which the moved values must fit in whether their nodes are taken or copied.
+	If the allocators differ and don't propagate, the nodes are copied using this tree's allocator. If the values don't fit in the budget or the allocator,
+	bad_alloc is thrown with both trees left intact */
+	basic_bit_branching_tree& operator=(basic_bit_branching_tree&& other)
+	{
+		if (this == &other) return *this;
+		if (!fitsInBudget(other.memoryUsage())) throw bad_alloc();
+
+		bool canTakeNodes = node_allocator_traits::propagate_on_container_move_assignment::value || nodeAllocator == other.nodeAllocator;
+		if (!canTakeNodes)
+		{ // The copy is made before this tree's nodes are destroyed, and it replaces them only once it is complete
+			bit_branching_tree_node* copy = other.root ? copySubtree(other.root) : nullptr;
+			clear();
+			root = copy;
+			other.clear();
+			return *this;
+		}
+
+		// Otherwise, the nodes can be deallocated by this tree's allocator, so they are taken as they are
+		clear();
+		if constexpr (node_allocator_traits::propagate_on_container_move_assignment::value)
+		{
+			nodeAllocator = move(other.nodeAllocator);
+		}
+		root = other.root;
+		other.root = nullptr;
+		return *this;
+	}
+
+	~basic_bit_branching_tree()
+	{
+		clear();
+	}
+
+	/* Erases every value in the tree */
+	void clear()
+	{
+		if (root)
+		{
+			destroySubtree(root);
+			root = nullptr;
+		}
+	}
+
+	/* Forgets every node without destroying or deallocating it, for pmr trees whose memory resource releases all of its memory at once (e.g., a monotonic buffer).
+	This skips the walk over the nodes that clear() and the destructor do, which is safe because the nodes are trivially destructible.
+	Only available to pmr trees, as any other allocator would leak the nodes */
+	void abandon()
+	{
+		static_assert(is_same<node_allocator, pmr::polymorphic_allocator<bit_branching_tree_node>>::value, "Only pmr trees can abandon their nodes to their memory resource");
+		static_assert(is_trivially_destructible<bit_branching_tree_node>::value, "Abandoned nodes must not need destroying");
+		root = nullptr;
+	}
+
+	/* Returns the memory in bytes taken by the tree's nodes */
+	size_t memoryUsage()
+	{
+		return distinctSize() * sizeof(bit_branching_tree_node);
+	}
+
+	/* Limits the memory in bytes the tree's nodes can take, where 0 means unlimited. Nodes already in the tree are kept even if they exceed it */
+	void setMemoryBudget(size_t bytes)
+	{
+		memoryBudget = bytes;
+	}
+
+	/* Inserts a new value into the tree, returning false if a node for it couldn't be allocated within the memory budget */
+	bool insert(int value)
 	{
 		// If the tree has no root, then the new value is inserted as the root and the function completes
 		if (!root)
 		{
-			root = new bit_branching_tree_node(value);
-			return;
+			if (!canCreateNode()) return false;
+			try
+			{
+				root = createNode(value);
+			}
+			catch (const bad_alloc&)
+			{
+				return false;
+			}
+			return true;
 		}
 
-		// Traces a path through the tree until the new value is inserted
+		// Traces a path through the tree until the new value is inserted, remembering it to update the subtree counters on it
+		// The path can't be longer than the key size, as every step branches at a lower bit than the one before it
+		bit_branching_tree_node* path[KEY_SIZE + 1];
+		int pathLength = 0;
 		bit_branching_tree_node* current = root;
 		while (true)
 		{
+			path[pathLength++] = current;
+
 			// Finds the longest common prefix between the node's value and the input by XORing them and counting the result's leading zeros
 			unsigned int bitDifference = current->value ^ value;
 			unsigned int longestCommonPrefixLength = countLeadingZeros(bitDifference);
@@ -149,7 +600,8 @@ public:
 			{
 				// The count of the matching node is increased instead of inserting a new node
 				current->count++;
-				return;
+				updatePath(path, pathLength, 1, 0);
+				return true;
 			}
 
 			// Creates a bit mask of the branching index and uses it to check whether or not the branch leads to a node
@@ -162,10 +614,19 @@ public:
 				current = current->branches[branchingIndex];
 			}
 			else
-			{ // Otherwise, make a node there, mark it in the reservedBranchesBitMask, and conclude
-				current->branches[branchingIndex] = new bit_branching_tree_node(value);
+			{ // Otherwise, make a node there (unless it doesn't fit), mark it in the reservedBranchesBitMask, and conclude
+				if (!canCreateNode()) return false;
+				try
+				{
+					current->branches[branchingIndex] = createNode(value);
+				}
+				catch (const bad_alloc&)
+				{
+					return false;
+				}
 				current->reservedPointersBitMask |= branchingBit;
-				return;
+				updatePath(path, pathLength, 1, 1);
+				return true;
 			}
 		}
 	}
@@ -173,13 +634,19 @@ public:
 	/* Erases a value from the tree */
 	bool erase(int value)
 	{
+		if (!root) return false;
+
 		bit_branching_tree_node* current = root;
 		bit_branching_tree_node* parent = nullptr;
 		unsigned int currentBranchingBit;
+		bit_branching_tree_node* path[KEY_SIZE + 1];
+		int pathLength = 0;
 
 		// Traces a path through the tree until the value is found and deleted, or until it certainly isn't 
 		while (true)
 		{
+			path[pathLength++] = current;
+
 			// Finds the longest common prefix between the node's value and the input by XORing them and counting the result's leading zeros
 			int bitDifference = current->value ^ value;
 			int longestCommonPrefixLength = countLeadingZeros(bitDifference);
@@ -189,10 +656,15 @@ public:
 				if (current->count >= 2)
 				{ // If the value was counted more than one time, its count is reduced, then the function terminates
 					current->count--;
+					updatePath(path, pathLength, -1, 0);
+					return true;
 				}
-				else if (current->reservedPointersBitMask == 0)
-				{ // Otherwise, if the value's node has no children, remove it
-					delete current;
+
+				// Otherwise, a node is removed from the subtree of every node on the path, including the current node if it gets replaced
+				updatePath(path, pathLength, -1, -1);
+				if (current->reservedPointersBitMask == 0)
+				{ // If the value's node has no children, remove it
+					destroyNode(current);
 					if (parent)
 					{ // If the remove node wasn't the root, indicate on its parent that its branch is no longer utilized
 						parent->reservedPointersBitMask &= ~currentBranchingBit;
@@ -222,7 +694,7 @@ public:
 						current->branches[subBranchIndex] = lastChild->branches[subBranchIndex];
 						lastChild->reservedPointersBitMask ^= subBranchBitMask;
 					}
-					delete lastChild; // Finally, deletes the hallow child
+					destroyNode(lastChild); // Finally, deletes the hallow child
 				}
 
 				return true; // Returns true, indicating that a matching node was found and erased
@@ -246,27 +718,176 @@ public:
 	/* Checkes whether or not the requested value is in the tree */
 	bool find(int value)
 	{
-		bit_branching_tree_node* current = root;
+		return findNode(value) != nullptr;
+	}
 
-		// Traces a path through the tree until the value is found, or until it is guranteed not to be in the tree
+	/* Returns the number of occurances of the requested value, or zero if it isn't in the tree */
+	int count(int value)
+	{
+		bit_branching_tree_node* node = findNode(value);
+		return node ? node->count : 0;
+	}
+
+	/* Returns the number of values in the tree, counting duplicates */
+	int size()
+	{
+		return root ? root->subtreeCount : 0;
+	}
+
+	/* Returns the number of distinct values in the tree */
+	int distinctSize()
+	{
+		return root ? root->subtreeNodeCount : 0;
+	}
+
+	/* Returns up to k (value, count) pairs of the most frequent values, ordered by descending count then ascending value */
+	vector<pair<int, int>> topKByFrequency(int k)
+	{
+		vector<pair<int, int>> mostFrequent;
+		if (!root || k <= 0) return mostFrequent;
+
+		mostFrequent.reserve(min(k, distinctSize()));
+		collectMostFrequent(mostFrequent, k, root);
+		sort_heap(mostFrequent.begin(), mostFrequent.end(), isMoreFrequent);
+		return mostFrequent;
+	}
+
+	/* Returns the number of values in the tree per bucket, where a value's bucket is its highest bucketBits bits.
+	As only positive values are supported, the sign bit is always 0, so at most KEY_SIZE - 2 bits can be requested */
+	vector<int> histogram(int bucketBits)
+	{
+		assert(bucketBits > 0 && bucketBits < KEY_SIZE - 1);
+		vector<int> histogram(1 << bucketBits, 0);
+		if (root)
+		{
+			histogramTraversal(histogram, bucketBits, root);
+		}
+		return histogram;
+	}
+
+	/* Returns the value at the given position of the tree in order, counting duplicates, using the subtree counters to skip whole branches */
+	int valueAt(int position)
+	{
+		assert(position >= 0 && position < size());
+		bit_branching_tree_node* current = root;
 		while (true)
 		{
-			// Finds the longest common prefix between the node's value and the input by XORing them and counting the result's leading zeros
-			int bitDifference = current->value ^ value;
-			int longestCommonPrefixLength = countLeadingZeros(bitDifference);
+			unsigned int unvisitedBranchesTo1sBitMask = current->reservedPointersBitMask & ~current->value;
+			unsigned int unvisitedBranchesTo0sBitMask = current->reservedPointersBitMask & current->value;
+			bit_branching_tree_node* next = nullptr;
 
-			// If the prefix length equals the key size, then the input value and node's value match, so a match is reported
-			if (longestCommonPrefixLength == KEY_SIZE) return true;
+			// Skips the smaller branches in order until the one holding the position is found
+			while (!next && unvisitedBranchesTo0sBitMask != 0)
+			{
+				int branchIndex = KEY_SIZE - 1 - countLeadingZeros(unvisitedBranchesTo0sBitMask);
+				bit_branching_tree_node* branch = current->branches[branchIndex];
+				if (position < branch->subtreeCount) next = branch;
+				else position -= branch->subtreeCount;
+				unvisitedBranchesTo0sBitMask ^= 1 << branchIndex;
+			}
 
-			unsigned int branchingIndex = KEY_SIZE - 1 - longestCommonPrefixLength;
-			unsigned int branchingBit = 1 << branchingIndex;
+			if (!next)
+			{
+				// If the position isn't in the smaller branches, it is either this node or in one of the larger branches
+				if (position < current->count) return current->value;
+				position -= current->count;
 
-			// Terminates if the next branch to follow has now node under it, as it is confirmed that the value to find isn't in the tree
-			bool branchAlreadyExists = (branchingBit & current->reservedPointersBitMask) > 0;
-			if (!branchAlreadyExists) return false;
+				while (!next)
+				{
+					int branchIndex = countTrailingZeros(unvisitedBranchesTo1sBitMask);
+					bit_branching_tree_node* branch = current->branches[branchIndex];
+					if (position < branch->subtreeCount) next = branch;
+					else position -= branch->subtreeCount;
+					unvisitedBranchesTo1sBitMask ^= 1 << branchIndex;
+				}
+			}
 
-			// Otherwise, continues to the next iteration using the next node in the path
-			current = current->branches[branchingIndex];
+			current = next;
+		}
+	}
+
+	/* Splits the tree into a tree of the values smaller than the key and a tree of the rest by moving whole branches. This tree is left empty */
+	pair<basic_bit_branching_tree, basic_bit_branching_tree> split(int key)
+	{
+		pair<basic_bit_branching_tree, basic_bit_branching_tree> trees(
+			basic_bit_branching_tree(nodeAllocator, memoryBudget),
+			basic_bit_branching_tree(nodeAllocator, memoryBudget)
+		);
+		splitSubtree(root, key, trees.first.root, trees.second.root);
+		root = nullptr;
+		return trees;
+	}
+
+	/* Joins two trees into one by moving whole branches, which only visits the nodes along their boundary if their ranges don't overlap. The trees are left empty.
+	The joined tree keeps the left tree's allocator and memory budget, which both trees' values must fit in (before duplicates are merged) whether their nodes are taken or copied.
+	If the allocators differ, the right tree's nodes are first copied using the left tree's allocator. If the values don't fit in the budget or the allocator,
+	bad_alloc is thrown with both trees left intact */
+	static basic_bit_branching_tree join(basic_bit_branching_tree& left, basic_bit_branching_tree& right)
+	{
+		// A tree joined with itself is returned as it is, as merging its nodes with themselves would destroy them
+		if (&left == &right)
+		{
+			return move(left);
+		}
+
+		basic_bit_branching_tree tree(left.nodeAllocator, left.memoryBudget);
+		if (!tree.fitsInBudget(left.memoryUsage() + right.memoryUsage())) throw bad_alloc();
+
+		bit_branching_tree_node* rightRoot = right.root;
+		if (rightRoot && left.nodeAllocator != right.nodeAllocator)
+		{ // Nodes can only be deallocated by the allocator that made them, so the joined tree gets its own copies
+			rightRoot = tree.copySubtree(right.root);
+			right.clear();
+		}
+
+		tree.root = tree.mergeSubtrees(left.root, rightRoot);
+		left.root = nullptr;
+		right.root = nullptr;
+		return tree;
+	}
+
+	/* Cuts the tree into up to k trees of consecutive ranges holding a near-equal number of values, so they can be processed in parallel. This tree is left empty */
+	vector<basic_bit_branching_tree> partition(int k)
+	{
+		vector<basic_bit_branching_tree> parts;
+		if (!root) return parts;
+
+		// Finds all the cutting values first, as splitting the tree changes the positions
+		vector<int> cuts;
+		int totalSize = size();
+		for (int i = 1; i < k; i++)
+		{
+			int cut = valueAt((long long)totalSize * i / k);
+			if (cuts.empty() || cuts.back() != cut)
+			{
+				cuts.push_back(cut);
+			}
+		}
+
+		for (int cut : cuts)
+		{
+			pair<basic_bit_branching_tree, basic_bit_branching_tree> trees = split(cut);
+			if (trees.first.root)
+			{
+				parts.push_back(move(trees.first));
+			}
+			// The rest holds this tree's own nodes, so they are taken back directly rather than through the budget-checked move assignment
+			root = trees.second.root;
+			trees.second.root = nullptr;
+		}
+		if (root)
+		{
+			parts.push_back(move(*this));
+		}
+		return parts;
+	}
+
+	/* Visits every distinct value in the tree in order along with its count */
+	void forEach(const function<void(int, int)>& visit)
+	{
+		if (root)
+		{
+			inOrderTraversal(visit, root);
 		}
 	}
 
@@ -274,12 +895,20 @@ public:
 	vector<int> toArray()
 	{
 		vector<int> array;
-		bit_branching_tree_node* node = root;
-		inOrderTraversal(array, root);
+		if (root)
+		{
+			inOrderTraversal(array, root);
+		}
 		return array;
 	}
 };
 
+/* The bit branching tree allocating its nodes on the heap */
+using bit_branching_tree = basic_bit_branching_tree<>;
+
+/* The bit branching tree allocating its nodes from a memory resource (e.g., a monotonic buffer that is released at once) */
+using pmr_bit_branching_tree = basic_bit_branching_tree<pmr::polymorphic_allocator<bit_branching_tree_node>>;
+
 /* Selectively measure specifc structure functions using the configurations at the top of the file */
 double measure(
 	vector<int>& array,
@@ -349,6 +978,98 @@ double measure(
 	return totalInMs;
 }
 
+/* Measures building a frequency table from the array and answering frequency queries on it, then erases the array's values from the structure without measuring */
+double measureFrequencies(
+	vector<int>& array,
+	const function<void(int)>& insert,
+	const function<void(int)>& count,
+	const function<void()>& analyze,
+	const function<void(int)>& erase
+) {
+	double total = 0;
+
+	for (int i = 0; i < RETRY_COUNT_FOR_AVERAGE; ++i) {
+		auto start = chrono::high_resolution_clock::now();
+		for (size_t j = 0; j < array.size(); ++j)
+		{
+			insert(array[j]);
+		}
+		for (size_t j = 0; j < array.size(); ++j)
+		{
+			count(array[j]);
+		}
+		analyze();
+		auto end = chrono::high_resolution_clock::now();
+		chrono::duration<double> elapsed = end - start;
+		total += elapsed.count();
+
+		for (size_t j = 0; j < array.size(); ++j)
+		{
+			erase(array[j]);
+		}
+	}
+
+	total /= RETRY_COUNT_FOR_AVERAGE;
+	double totalInMs = total * 1000;
+	return totalInMs;
+}
+
+/* Measures rebalancing a structure built from the array, then erases the array's values from the structure without measuring */
+double measureRebalancing(
+	vector<int>& array,
+	const function<void(int)>& insert,
+	const function<void()>& rebalance,
+	const function<void(int)>& erase
+) {
+	double total = 0;
+
+	for (int i = 0; i < RETRY_COUNT_FOR_AVERAGE; ++i) {
+		for (size_t j = 0; j < array.size(); ++j)
+		{
+			insert(array[j]);
+		}
+
+		auto start = chrono::high_resolution_clock::now();
+		rebalance();
+		auto end = chrono::high_resolution_clock::now();
+		chrono::duration<double> elapsed = end - start;
+		total += elapsed.count();
+
+		for (size_t j = 0; j < array.size(); ++j)
+		{
+			erase(array[j]);
+		}
+	}
+
+	total /= RETRY_COUNT_FOR_AVERAGE;
+	double totalInMs = total * 1000;
+	return totalInMs;
+}
+
+/* Measures handling the array as consecutive requests of REQUEST_SIZE values, where each request builds and tears down its own structure */
+double measureRequests(
+	vector<int>& array,
+	const function<void(const int*, const int*)>& handleRequest
+) {
+	double total = 0;
+
+	for (int i = 0; i < RETRY_COUNT_FOR_AVERAGE; ++i) {
+		auto start = chrono::high_resolution_clock::now();
+		for (size_t requestStart = 0; requestStart < array.size(); requestStart += REQUEST_SIZE)
+		{
+			size_t requestEnd = min(requestStart + REQUEST_SIZE, array.size());
+			handleRequest(array.data() + requestStart, array.data() + requestEnd);
+		}
+		auto end = chrono::high_resolution_clock::now();
+		chrono::duration<double> elapsed = end - start;
+		total += elapsed.count();
+	}
+
+	total /= RETRY_COUNT_FOR_AVERAGE;
+	double totalInMs = total * 1000;
+	return totalInMs;
+}
+
 /* Checks whether or not the given array is sorted */
 static bool isSorted(const vector<int>& array)
 {
@@ -427,10 +1148,146 @@ int main()
 			[&hashMap](int value) { hashMap.erase(value); }
 		);
 		
+		// Generates values from a smaller range so that they repeat, then measures frequency analytics
+		vector<int> frequencyArray;
+		uniform_int_distribution<> frequencyDis(0, FREQUENCY_MAX_VALUE == 0 ? size / 100 : FREQUENCY_MAX_VALUE);
+		for (int k = 0; k < size; ++k)
+		{
+			frequencyArray.push_back(frequencyDis(gen));
+		}
+
+		vector<pair<int, int>> mostFrequent;
+		vector<int> histogram;
+		double bitBranchingTreeFrequencyTime = measureFrequencies(
+			frequencyArray,
+			[&bitBranchingTree](int value) { bitBranchingTree.insert(value); },
+			[&bitBranchingTree](int value) { bitBranchingTree.count(value); },
+			[&bitBranchingTree, &mostFrequent, &histogram]() {
+				mostFrequent = bitBranchingTree.topKByFrequency(TOP_K);
+				histogram = bitBranchingTree.histogram(HISTOGRAM_BUCKET_BITS);
+				assert(bitBranchingTree.distinctSize() <= bitBranchingTree.size());
+			},
+			[&bitBranchingTree](int value) { bitBranchingTree.erase(value); }
+		);
+		assert(bitBranchingTree.size() == 0);
+
+		unordered_map<int, int> countingMap;
+		double countingMapFrequencyTime = measureFrequencies(
+			frequencyArray,
+			[&countingMap](int value) { countingMap[value]++; },
+			[&countingMap](int value) { countingMap.find(value); },
+			[&countingMap, &mostFrequent, &histogram]() {
+				vector<pair<int, int>> counts(countingMap.begin(), countingMap.end());
+				auto isMoreFrequent = [](const pair<int, int>& a, const pair<int, int>& b) {
+					return a.second > b.second || (a.second == b.second && a.first < b.first);
+				};
+				size_t k = min(counts.size(), (size_t)TOP_K);
+				partial_sort(counts.begin(), counts.begin() + k, counts.end(), isMoreFrequent);
+				counts.resize(k);
+				assert(counts == mostFrequent);
+
+				vector<int> mapHistogram(1 << HISTOGRAM_BUCKET_BITS, 0);
+				for (auto& count : countingMap)
+				{
+					mapHistogram[(unsigned int)count.first >> (KEY_SIZE - HISTOGRAM_BUCKET_BITS)] += count.second;
+				}
+				assert(mapHistogram == histogram);
+			},
+			[&countingMap](int value) { countingMap.erase(value); }
+		);
+
+		// Measures moving the upper half of the tree into another tree and back, by splitting and joining
+		vector<int> medianArray = insertionArray;
+		nth_element(medianArray.begin(), medianArray.begin() + size / 2, medianArray.end());
+		int median = medianArray[size / 2];
+		double splitJoinRebalanceTime = measureRebalancing(
+			insertionArray,
+			[&bitBranchingTree](int value) { bitBranchingTree.insert(value); },
+			[&bitBranchingTree, &median]() {
+				pair<bit_branching_tree, bit_branching_tree> halves = bitBranchingTree.split(median);
+				bitBranchingTree = bit_branching_tree::join(halves.first, halves.second);
+			},
+			[&bitBranchingTree](int value) { bitBranchingTree.erase(value); }
+		);
+
+		// Measures the same as above by erasing the upper half's values one by one and inserting them into another tree and back
+		bit_branching_tree upperHalfTree;
+		double eraseInsertRebalanceTime = measureRebalancing(
+			insertionArray,
+			[&bitBranchingTree](int value) { bitBranchingTree.insert(value); },
+			[&bitBranchingTree, &upperHalfTree, &insertionArray, &median]() {
+				for (int value : insertionArray)
+				{
+					if (value >= median && bitBranchingTree.erase(value)) upperHalfTree.insert(value);
+				}
+				for (int value : insertionArray)
+				{
+					if (value >= median && upperHalfTree.erase(value)) bitBranchingTree.insert(value);
+				}
+			},
+			[&bitBranchingTree](int value) { bitBranchingTree.erase(value); }
+		);
+
+		// Measures cutting the tree into ranges for parallel processing and joining them back
+		double partitionRebalanceTime = measureRebalancing(
+			insertionArray,
+			[&bitBranchingTree](int value) { bitBranchingTree.insert(value); },
+			[&bitBranchingTree, &size]() {
+				vector<bit_branching_tree> parts = bitBranchingTree.partition(PARTITION_COUNT);
+				assert(parts.size() <= PARTITION_COUNT);
+				for (bit_branching_tree& part : parts)
+				{
+					bitBranchingTree = bit_branching_tree::join(bitBranchingTree, part);
+				}
+				assert(bitBranchingTree.size() == size);
+			},
+			[&bitBranchingTree](int value) { bitBranchingTree.erase(value); }
+		);
+
+		// Measures building and tearing down a short-lived tree per request with nodes on the heap
+		double heapRequestsTime = measureRequests(
+			insertionArray,
+			[](const int* begin, const int* end) {
+				bit_branching_tree tree;
+				for (const int* value = begin; value != end; ++value)
+				{
+					tree.insert(*value);
+				}
+			}
+		);
+
+		// Measures the same as above with nodes in a reused buffer that is released in one shot per request
+		// The tree's budget matches the buffer, so an insert that doesn't fit fails instead of reaching for more memory
+		vector<char> requestBuffer(REQUEST_SIZE * sizeof(bit_branching_tree_node));
+		double pmrRequestsTime = measureRequests(
+			insertionArray,
+			[&requestBuffer](const int* begin, const int* end) {
+				pmr::monotonic_buffer_resource resource(requestBuffer.data(), requestBuffer.size(), pmr::null_memory_resource());
+				pmr_bit_branching_tree tree(&resource, requestBuffer.size());
+				for (const int* value = begin; value != end; ++value)
+				{
+					bool inserted = tree.insert(*value);
+					assert(inserted);
+					(void)inserted;
+				}
+				assert(tree.memoryUsage() <= requestBuffer.size());
+
+				// The buffer is released in one shot when the resource goes out of scope, so the nodes don't need to be walked
+				tree.abandon();
+			}
+		);
+
 		cout << "Number of operations: " << size << endl;
 		cout << "Bit Branching Tree Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << bitBranchingTreeTotalTime << " ms" << endl;
 		cout << "Binary Search Tree Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << binaryTreeTotalTime << " ms" << endl;
 		cout << "Hash Map Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << hashMapTotalTime << " ms" << endl;
+		cout << "Bit Branching Tree Frequency Analytics Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << bitBranchingTreeFrequencyTime << " ms" << endl;
+		cout << "Hash Map Counting Frequency Analytics Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << countingMapFrequencyTime << " ms" << endl;
+		cout << "Bit Branching Tree Split/Join Rebalancing Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << splitJoinRebalanceTime << " ms" << endl;
+		cout << "Bit Branching Tree Erase/Insert Rebalancing Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << eraseInsertRebalanceTime << " ms" << endl;
+		cout << "Bit Branching Tree Partition/Join Rebalancing (into " << PARTITION_COUNT << " ranges) Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << partitionRebalanceTime << " ms" << endl;
+		cout << "Bit Branching Tree Heap Per-Request Build/Teardown (of " << REQUEST_SIZE << " values) Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << heapRequestsTime << " ms" << endl;
+		cout << "Bit Branching Tree PMR Per-Request Build/Teardown (of " << REQUEST_SIZE << " values) Average Execution time (of " << RETRY_COUNT_FOR_AVERAGE << " attempts): " << pmrRequestsTime << " ms" << endl;
 		cout << endl;
 	}
 	return 0;